@@ -6,12 +6,53 @@
 #include <cstring>           // For c-string functions such as strlen()  
 #include <chrono>            // Used in pausing for some milliseconds using sleep_for(...)
 #include <thread>            // Used in pausing for some milliseconds using sleep_for(...)
+#include <vector>            // Used by the score store to keep each board size's games
+#include <algorithm>         // Used to keep games and solver boards sorted
+#include <random>            // For std::random_device, used to seed the random number generator for each game
+#include <ctime>             // For clock_gettime(...), used to measure the time since the process started
+#include <string>            // For std::to_string, used in naming solver files
+#include <map>               // Used by the solver to track run files for each layer
+#include <queue>             // Used by the solver to merge sorted files
+#include <mutex>             // Used by the solver's worker threads
+#include <functional>        // Used to hand work to the solver's worker threads
+#include <unistd.h>          // For fsync(...), ftruncate(...) and unlink(...)
+#include <fcntl.h>           // For open(...), used to map solver files
+#include <sys/mman.h>        // For mmap(...), used to read and write solver files in place
+#include <sys/stat.h>        // For fstat(...) and mkdir(...)
+#include <sys/file.h>        // For flock(...), used to share the score file between processes
+#include <cerrno>            // For errno, used to tell why the solver could not make its work directory
+
+// Taken when main.cpp's globals are set up, after the loader has loaded SFML and OpenGL.
+// Only used to time startup when the process start time cannot be read from /proc.
+const std::chrono::steady_clock::time_point ProcessStart = std::chrono::steady_clock::now();
 
 const int WindowXSize = 800;
 const int WindowYSize = 1000;
 const int MaxBoardSize = 12;  // Max number of squares per side
 const int MaxTileStartValue = 1024;   // Max tile value to start out on a 4x4 board
+const int GlyphWidth = 5;             // Width of each glyph in the built-in font, in pixels
+const int GlyphHeight = 7;            // Height of each glyph in the built-in font, in pixels
+const int SolverSquaresPerSide = 4;   // The exact solver only handles 4x4 boards
+const size_t SolverRunBoards = 1 << 21;   // Boards each solver thread collects before writing a sorted run file
+const int AutoplayFrameMilliseconds = 16;   // Time between redraws during autoplay, about 60 per second
+const int AutoplaySpeeds[] = { 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 0};   // Autoplay moves per second, 0 is unlimited
+const int AutoplaySpeedCount = sizeof( AutoplaySpeeds) / sizeof( AutoplaySpeeds[ 0]);
+const int SliderXPosition = 20;       // Left end of the autoplay speed slider
+const int SliderYPosition = WindowYSize - 70;
+const int SliderWidth = 500;
+const int SliderKnobWidth = 12;
+const char ScoreFileName[] = "scores.dat";   // Every finished game is appended to this file
+const char ScoreIndexFileName[] = "scores.idx";   // Per board size index of the games in ScoreFileName
+const char ScoreIndexMagic[ 8] = { 'T', '1', '0', '2', '4', 'I', 'X', '2'};
+const int ScoreIndexTopGames = 100;   // Number of best games kept in the index for each board size
+const int ScoreIndexSaveBatch = 4096; // Number of games appended between each save of the index
+const int ScoreSyncBatch = 32;        // Number of games appended between each fsync of the score file
+const int LeaderboardSize = 5;        // Number of top scores shown for each board size
+const int LeaderboardXPosition = 20;  // Left edge of the leaderboards in the window
+const int LeaderboardYPosition = 740; // Top of the leaderboards in the window
+
 
+class GlyphAtlas;   // Built-in font, defined below
 
 //---------------------------------------------------------------------------------------
 class Square {
@@ -83,7 +124,7 @@ class Square {
 		void setText( std::string theText) { text = theText; }
 
 		// Utility functions
-		void displayText( sf::RenderWindow *pWindow, sf::Font theFont, sf::Color theColor, int textSize);
+		void displayText( sf::RenderWindow *pWindow, GlyphAtlas &theFont, sf::Color theColor, int textSize);
 	
 	private:
 		int size;
@@ -99,56 +140,174 @@ class Square {
 
 
 //---------------------------------------------------------------------------------------
-// Square class utility function to create a sf::Text object to store and display text 
-// associated with this Square.
-// 
-// Assuming we display output in sf::RenderWindow window(...), then call this function using: 
-//    aSquare.displayTest( &window);
+// Characters in the built-in font.  Lower case letters are drawn as upper case
+// and anything else missing is drawn as a space.
+const char GlyphCharacters[] = " 0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:/()%-!,";
+const int GlyphCount = sizeof( GlyphCharacters) - 1;
+
+// Pixels of each character above, one row per byte from the top, with the
+// left-most pixel in the 0x10 bit.  Baking the glyphs into the program means
+// nothing has to be loaded or rasterized from a font file at startup.
+const unsigned char GlyphRows[ GlyphCount][ GlyphHeight] = {
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00},   // space
+	{0x0E,0x11,0x13,0x15,0x19,0x11,0x0E},   // 0
+	{0x04,0x0C,0x04,0x04,0x04,0x04,0x0E},   // 1
+	{0x0E,0x11,0x01,0x02,0x04,0x08,0x1F},   // 2
+	{0x1F,0x02,0x04,0x02,0x01,0x11,0x0E},   // 3
+	{0x02,0x06,0x0A,0x12,0x1F,0x02,0x02},   // 4
+	{0x1F,0x10,0x1E,0x01,0x01,0x11,0x0E},   // 5
+	{0x06,0x08,0x10,0x1E,0x11,0x11,0x0E},   // 6
+	{0x1F,0x01,0x02,0x04,0x08,0x08,0x08},   // 7
+	{0x0E,0x11,0x11,0x0E,0x11,0x11,0x0E},   // 8
+	{0x0E,0x11,0x11,0x0F,0x01,0x02,0x0C},   // 9
+	{0x0E,0x11,0x11,0x1F,0x11,0x11,0x11},   // A
+	{0x1E,0x11,0x11,0x1E,0x11,0x11,0x1E},   // B
+	{0x0E,0x11,0x10,0x10,0x10,0x11,0x0E},   // C
+	{0x1C,0x12,0x11,0x11,0x11,0x12,0x1C},   // D
+	{0x1F,0x10,0x10,0x1E,0x10,0x10,0x1F},   // E
+	{0x1F,0x10,0x10,0x1E,0x10,0x10,0x10},   // F
+	{0x0E,0x11,0x10,0x17,0x11,0x11,0x0F},   // G
+	{0x11,0x11,0x11,0x1F,0x11,0x11,0x11},   // H
+	{0x0E,0x04,0x04,0x04,0x04,0x04,0x0E},   // I
+	{0x07,0x02,0x02,0x02,0x02,0x12,0x0C},   // J
+	{0x11,0x12,0x14,0x18,0x14,0x12,0x11},   // K
+	{0x10,0x10,0x10,0x10,0x10,0x10,0x1F},   // L
+	{0x11,0x1B,0x15,0x15,0x11,0x11,0x11},   // M
+	{0x11,0x11,0x19,0x15,0x13,0x11,0x11},   // N
+	{0x0E,0x11,0x11,0x11,0x11,0x11,0x0E},   // O
+	{0x1E,0x11,0x11,0x1E,0x10,0x10,0x10},   // P
+	{0x0E,0x11,0x11,0x11,0x15,0x12,0x0D},   // Q
+	{0x1E,0x11,0x11,0x1E,0x14,0x12,0x11},   // R
+	{0x0F,0x10,0x10,0x0E,0x01,0x01,0x1E},   // S
+	{0x1F,0x04,0x04,0x04,0x04,0x04,0x04},   // T
+	{0x11,0x11,0x11,0x11,0x11,0x11,0x0E},   // U
+	{0x11,0x11,0x11,0x11,0x11,0x0A,0x04},   // V
+	{0x11,0x11,0x11,0x15,0x15,0x15,0x0A},   // W
+	{0x11,0x11,0x0A,0x04,0x0A,0x11,0x11},   // X
+	{0x11,0x11,0x11,0x0A,0x04,0x04,0x04},   // Y
+	{0x1F,0x01,0x02,0x04,0x08,0x10,0x1F},   // Z
+	{0x00,0x00,0x00,0x00,0x00,0x0C,0x0C},   // .
+	{0x00,0x0C,0x0C,0x00,0x0C,0x0C,0x00},   // :
+	{0x00,0x01,0x02,0x04,0x08,0x10,0x00},   // /
+	{0x02,0x04,0x08,0x08,0x08,0x04,0x02},   // (
+	{0x08,0x04,0x02,0x02,0x02,0x04,0x08},   // )
+	{0x18,0x19,0x02,0x04,0x08,0x13,0x03},   // %
+	{0x00,0x00,0x00,0x1F,0x00,0x00,0x00},   // -
+	{0x04,0x04,0x04,0x04,0x04,0x00,0x04},   // !
+	{0x00,0x00,0x00,0x00,0x0C,0x04,0x08},   // ,
+};
+
+
+//---------------------------------------------------------------------------------------
+// Built-in font.  All glyphs are copied side by side into one small texture,
+// so each string is drawn as a single batch of quads cut out of it.
+class GlyphAtlas {
+	public:
+		// Default Constructor
+		GlyphAtlas()
+		{
+			for( int i=0; i<128; i++) {
+				glyphIndex[ i] = 0;   // Characters not in the font are drawn as a space
+			}
+			for( int i=0; i<GlyphCount; i++) {
+				glyphIndex[ (int)GlyphCharacters[ i]] = i;
+				if( GlyphCharacters[ i] >= 'A' && GlyphCharacters[ i] <= 'Z') {
+					glyphIndex[ GlyphCharacters[ i] - 'A' + 'a'] = i;
+				}
+			}
+		}
+
+		// Copy the glyphs into the texture.  The window must have been created first.
+		void load()
+		{
+			sf::Image image;
+			image.create( GlyphCount * (GlyphWidth + 1), GlyphHeight, sf::Color(0, 0, 0, 0));
+			for( int i=0; i<GlyphCount; i++) {
+				for( int row=0; row<GlyphHeight; row++) {
+					for( int col=0; col<GlyphWidth; col++) {
+						if( GlyphRows[ i][ row] & (0x10 >> col)) {
+							image.setPixel( i * (GlyphWidth + 1) + col, row, sf::Color::White);
+						}
+					}
+				}
+			}
+			texture.loadFromImage( image);
+		}
+
+		// Pixel scale for text of the given size, which is roughly its height in pixels
+		int scaleFor( int textSize) {
+			int scale = textSize / (GlyphHeight + 1);
+			return (scale > 1) ? scale : 1;
+		}
+
+		// Width in pixels of the text drawn at the given scale
+		int textWidth( std::string text, int scale) {
+			if( text.empty()) {
+				return 0;
+			}
+			return text.length() * (GlyphWidth + 1) * scale - scale;
+		}
+
+		// Draw text with its upper-left corner at x,y
+		void drawText( sf::RenderWindow &window, std::string text, int x, int y, int scale, sf::Color color)
+		{
+			sf::VertexArray quads( sf::Quads, text.length() * 4);
+			for( size_t i=0; i<text.length(); i++) {
+				int glyph = glyphIndex[ text[ i] & 0x7F];
+				float left = x + i * (GlyphWidth + 1) * scale;
+				float right = left + GlyphWidth * scale;
+				float top = y;
+				float bottom = y + GlyphHeight * scale;
+				float textureLeft = glyph * (GlyphWidth + 1);
+				float textureRight = textureLeft + GlyphWidth;
+				quads[ i*4 + 0] = sf::Vertex( sf::Vector2f( left, top),     color, sf::Vector2f( textureLeft, 0));
+				quads[ i*4 + 1] = sf::Vertex( sf::Vector2f( right, top),    color, sf::Vector2f( textureRight, 0));
+				quads[ i*4 + 2] = sf::Vertex( sf::Vector2f( right, bottom), color, sf::Vector2f( textureRight, GlyphHeight));
+				quads[ i*4 + 3] = sf::Vertex( sf::Vector2f( left, bottom),  color, sf::Vector2f( textureLeft, GlyphHeight));
+			}
+			window.draw( quads, &texture);
+		}
+
+	private:
+		int glyphIndex[ 128];   // Position of each ASCII character in GlyphCharacters
+		sf::Texture texture;
+
+}; //end class GlyphAtlas
+
+
+//---------------------------------------------------------------------------------------
+// Square class utility function to draw the text associated with this Square,
+// centered in the Square.
+//
+// Assuming we display output in sf::RenderWindow window(...), then call this function using:
+//    aSquare.displayText( &window, font, color, size);
 // or when using an array of Square pointers declared as:  Square *squaresArray[ 4];
-// then call it using:  squaresArray[i]->displayText( &window);
-void Square::displayText( 
+// then call it using:  squaresArray[i]->displayText( &window, font, color, size);
+void Square::displayText(
 		sf::RenderWindow *pWindow,   // The window into which we draw everything
-		sf::Font theFont,            // Font to be used in displaying text   
+		GlyphAtlas &theFont,         // Font to be used in displaying text
 		sf::Color theColor,          // Color of the font
 		int textSize)                // Size of the text to be displayed
-{	
-	// Create a sf::Text object to draw the text, using a sf::Text constructor
-	sf::Text theText( text,        // text is a class data member
-					  theFont,     // font from a font file, passed as a parameter
-					  textSize);   // this is the size of text to be displayed
-
+{
 	// Text color is the designated one, unless the background is Yellow, in which case the text
 	// color gets changed to blue so we can see it, since we can't see white-on-yellow very well
 	if( this->getColor() == sf::Color::Yellow) {
 		theColor = sf::Color::Blue;
 	}
-	theText.setColor( theColor);
 
-	// Place text in the corresponding square, centered in both x (horizontally) and y (vertically)
-	// For horizontal center, find the center of the square and subtract half the width of the text 
-	int theXPosition = xPosition + (size / 2) - ((strlen(text.c_str()) * theText.getCharacterSize()) / 2);
-	// For the vertical center, from the top of the square go down the amount: (square size - text size) / 2
-	int theYPosition = yPosition + (size - theText.getCharacterSize()) / 2;
-	// Use an additional offset to get it centered
-	int offset = 5;
-	theText.setPosition( theXPosition + offset, theYPosition - offset);
-
-	// Finally draw the Text object in the RenderWindow
-	pWindow->draw( theText);
-}//end displayText
+	// Shrink long numbers until they fit inside the square
+	int scale = theFont.scaleFor( textSize);
+	while( scale > 1 && theFont.textWidth( text, scale) > size - 4) {
+		scale--;
+	}
 
+	// Place text in the corresponding square, centered in both x (horizontally) and y (vertically)
+	int theXPosition = xPosition + (size - theFont.textWidth( text, scale)) / 2;
+	int theYPosition = yPosition + (size - GlyphHeight * scale) / 2;
 
-//---------------------------------------------------------------------------------------
-// Initialize the font
-void initializeFont( sf::Font &theFont)
-{
-	// Create the global font object from the font file
-	if (!theFont.loadFromFile("arial.ttf"))
-	{
-		std::cout << "Unable to load font. " << std::endl;
-		exit( -1);
-	}	
-}//end initializeFont
+	// Finally draw the text in the RenderWindow
+	theFont.drawText( *pWindow, text, theXPosition, theYPosition, scale, theColor);
+}//end displayText
 
 //--------------------------------------------------------------------
 // Function to copy a board into another
@@ -234,6 +393,297 @@ class LinkedList {
     }
 };//end LinkedList Class
 
+//--------------------------------------------------------------------
+// Return true if a board of this size can be played and have its scores saved
+bool isValidBoardSize(int squaresPerSide) { return squaresPerSide >= 4 && squaresPerSide <= MaxBoardSize; }
+
+//--------------------------------------------------------------------
+// One finished game, as stored in the score file
+struct GameRecord {
+    int squaresPerSide;
+    int score;
+    int maxTile;
+    int moves;
+    int milliseconds;     // how long the game took
+    unsigned int seed;    // seed passed to srand() at the start of the game
+};
+
+// Used to keep each board size's games sorted from highest to lowest score
+bool higherScore(const GameRecord &a, const GameRecord &b) { return a.score > b.score; }
+
+//--------------------------------------------------------------------
+// Append-only store of every finished game.  Records have a fixed size
+// and are only ever added to the end of the score file.  Queries never
+// read that file: for each board size an index keeps the number of games,
+// the best ScoreIndexTopGames games, and how many games got each score,
+// so the top scores are the front of a short list and the rank of a score
+// is a count over the distinct scores, however many games there are.
+// New games are written straight away but only forced to disk with
+// fsync() every ScoreSyncBatch games and when the store is closed.  The
+// index is saved to its own file every ScoreIndexSaveBatch games and on
+// close, noting how many records it covers and the last of them, so at
+// startup only games added after it was saved, such as before a crash,
+// are read back from the score file.
+//
+// Several processes may share the score file.  Each append and each save
+// of the index is done holding flock() on the score file, and first reads
+// in any games the other processes appended, so the index always covers
+// exactly the records in the file.
+class ScoreStore {
+    private:
+    FILE* file;
+    int unsyncedGames;
+    int unsavedGames;     // games added since the index was last saved
+    std::string indexName;
+    long long indexedGames;                                 // records in the score file covered by the index
+    GameRecord lastGame;                                    // last record covered, to check the index against the file
+    long long gamesBySize[ MaxBoardSize + 1];               // number of games for each board size
+    std::vector<GameRecord> topBySize[ MaxBoardSize + 1];   // best games for each board size, highest score first
+    std::map<int, int> scoreCounts[ MaxBoardSize + 1];      // number of games with each score, for each board size
+
+    // Add a game to the index for its board size
+    void addToIndex(GameRecord &record) {
+        int size = record.squaresPerSide;
+        gamesBySize[ size]++;
+        scoreCounts[ size][ record.score]++;
+        std::vector<GameRecord> &top = topBySize[ size];
+        if( (int)top.size() < ScoreIndexTopGames || record.score > top.back().score) {
+            top.insert( std::upper_bound( top.begin(), top.end(), record, higherScore), record);
+            if( (int)top.size() > ScoreIndexTopGames) {
+                top.pop_back();
+            }
+        }
+    }
+
+    // Forget everything in the index
+    void clearIndex() {
+        indexedGames = 0;
+        memset( &lastGame, 0, sizeof( lastGame));
+        for( int size=0; size<=MaxBoardSize; size++) {
+            gamesBySize[ size] = 0;
+            topBySize[ size].clear();
+            scoreCounts[ size].clear();
+        }
+    }
+
+    // Read the index file.  Returns false if it is missing or damaged.
+    bool loadIndex() {
+        FILE* input = fopen( indexName.c_str(), "rb");
+        if( input == NULL) {
+            return false;
+        }
+        char magic[ 8];
+        bool ok = fread( magic, sizeof( magic), 1, input) == 1 && memcmp( magic, ScoreIndexMagic, sizeof( magic)) == 0 &&
+                  fread( &indexedGames, sizeof( indexedGames), 1, input) == 1 &&
+                  fread( &lastGame, sizeof( lastGame), 1, input) == 1;
+        for( int size=4; ok && size<=MaxBoardSize; size++) {
+            int topCount, distinctScores;
+            ok = fread( &gamesBySize[ size], sizeof( gamesBySize[ size]), 1, input) == 1 &&
+                 fread( &topCount, sizeof( topCount), 1, input) == 1 &&
+                 topCount >= 0 && topCount <= ScoreIndexTopGames;
+            if( ok) {
+                topBySize[ size].resize( topCount);
+                ok = (topCount == 0 || fread( &topBySize[ size][ 0], sizeof( GameRecord), topCount, input) == (size_t)topCount) &&
+                     fread( &distinctScores, sizeof( distinctScores), 1, input) == 1 && distinctScores >= 0;
+            }
+            for( int i=0; ok && i<distinctScores; i++) {
+                int scoreAndCount[ 2];
+                ok = fread( scoreAndCount, sizeof( scoreAndCount), 1, input) == 1;
+                scoreCounts[ size][ scoreAndCount[ 0]] = scoreAndCount[ 1];
+            }
+        }
+        fclose( input);
+        if( !ok) {
+            clearIndex();
+        }
+        return ok;
+    }
+
+    // Return true if the index matches the score file: the file holds at least the
+    // records the index covers, and the last of them is the one the index saved
+    bool indexMatchesFile() {
+        struct stat fileStatus;
+        if( fstat( fileno( file), &fileStatus) != 0 ||
+            (long long)(fileStatus.st_size / sizeof( GameRecord)) < indexedGames) {
+            return false;
+        }
+        if( indexedGames == 0) {
+            return true;
+        }
+        GameRecord record;
+        return pread( fileno( file), &record, sizeof( record), (indexedGames - 1) * sizeof( GameRecord)) == sizeof( record) &&
+               memcmp( &record, &lastGame, sizeof( record)) == 0;
+    }
+
+    // Read in the records past indexedGames, which other processes sharing the file
+    // appended, then cut off a partly written record left by a crash so later records
+    // stay aligned.  The file must be locked.
+    void catchUp() {
+        struct stat fileStatus;
+        if( fstat( fileno( file), &fileStatus) != 0) {
+            return;
+        }
+        long long recordsInFile = fileStatus.st_size / sizeof( GameRecord);
+        GameRecord records[ 4096];
+        while( indexedGames < recordsInFile) {
+            long long count = (recordsInFile - indexedGames < 4096) ? recordsInFile - indexedGames : 4096;
+            if( pread( fileno( file), records, count * sizeof( GameRecord), indexedGames * sizeof( GameRecord))
+                    != (ssize_t)(count * sizeof( GameRecord))) {
+                break;
+            }
+            for( long long i=0; i<count; i++) {
+                if( isValidBoardSize( records[ i].squaresPerSide)) {
+                    addToIndex( records[ i]);
+                }
+                lastGame = records[ i];
+                indexedGames++;
+                unsavedGames++;
+            }
+        }
+        if( fileStatus.st_size != (off_t)(indexedGames * sizeof( GameRecord)) &&
+            ftruncate( fileno( file), indexedGames * sizeof( GameRecord)) != 0) {
+            std::cout << "Unable to repair the score file. " << std::endl;
+        }
+    }
+
+    // Write the index to a new file, then swap it in so a crash never leaves half an index.
+    // The file must be locked and caught up.
+    void saveIndex() {
+        unsavedGames = 0;
+        std::string newName = indexName + ".new";
+        FILE* output = fopen( newName.c_str(), "wb");
+        if( output == NULL) {
+            return;
+        }
+        fwrite( ScoreIndexMagic, sizeof( ScoreIndexMagic), 1, output);
+        fwrite( &indexedGames, sizeof( indexedGames), 1, output);
+        fwrite( &lastGame, sizeof( lastGame), 1, output);
+        for( int size=4; size<=MaxBoardSize; size++) {
+            int topCount = topBySize[ size].size();
+            int distinctScores = scoreCounts[ size].size();
+            fwrite( &gamesBySize[ size], sizeof( gamesBySize[ size]), 1, output);
+            fwrite( &topCount, sizeof( topCount), 1, output);
+            if( topCount > 0) {
+                fwrite( &topBySize[ size][ 0], sizeof( GameRecord), topCount, output);
+            }
+            fwrite( &distinctScores, sizeof( distinctScores), 1, output);
+            for( std::map<int, int>::iterator it = scoreCounts[ size].begin(); it != scoreCounts[ size].end(); it++) {
+                int scoreAndCount[ 2] = { it->first, it->second};
+                fwrite( scoreAndCount, sizeof( scoreAndCount), 1, output);
+            }
+        }
+        fflush( output);
+        fsync( fileno( output));
+        fclose( output);
+        rename( newName.c_str(), indexName.c_str());
+    }
+
+    public:
+    ScoreStore() {
+        file = NULL;
+        unsyncedGames = 0;
+        unsavedGames = 0;
+        clearIndex();
+    }
+    ~ScoreStore() { close(); }
+
+    // Open the score file for appending, then read the index and catch it up with any games it does not cover
+    void open(const char* fileName, const char* theIndexName) {
+        indexName = theIndexName;
+        file = fopen( fileName, "a+b");
+        if( file == NULL) {
+            std::cout << "Unable to open " << fileName << ", scores will not be saved. " << std::endl;
+            return;
+        }
+        flock( fileno( file), LOCK_EX);
+        // An index that does not match the file, such as one saved before the file was replaced, is rebuilt
+        if( !loadIndex() || !indexMatchesFile()) {
+            clearIndex();
+        }
+        catchUp();
+        if( unsavedGames > 0) {
+            saveIndex();
+        }
+        flock( fileno( file), LOCK_UN);
+    }
+
+    // Add a finished game to the file and to the index for its board size
+    void add(GameRecord &record) {
+        if( !isValidBoardSize( record.squaresPerSide)) {
+            return;   // Same rule as catchUp(), which would skip it when reading it back
+        }
+        if( file == NULL) {
+            addToIndex( record);
+            return;
+        }
+        flock( fileno( file), LOCK_EX);
+        catchUp();
+        // Written out while locked, so games from different processes never interleave
+        fwrite( &record, sizeof( GameRecord), 1, file);
+        fflush( file);
+        addToIndex( record);
+        lastGame = record;
+        indexedGames++;
+        unsyncedGames++;
+        unsavedGames++;
+        if( unsyncedGames >= ScoreSyncBatch) {
+            sync();
+        }
+        if( unsavedGames >= ScoreIndexSaveBatch) {
+            sync();        // The index must only cover games that are on the disk
+            saveIndex();
+        }
+        flock( fileno( file), LOCK_UN);
+    }
+
+    // Force all games written so far onto the disk
+    void sync() {
+        if( file != NULL && unsyncedGames > 0) {
+            fflush( file);
+            fsync( fileno( file));
+            unsyncedGames = 0;
+        }
+    }
+
+    // Sync and close the file, and save the index if it is behind
+    void close() {
+        if( file != NULL) {
+            flock( fileno( file), LOCK_EX);
+            sync();
+            catchUp();
+            if( unsavedGames > 0) {
+                saveIndex();
+            }
+            flock( fileno( file), LOCK_UN);
+            fclose( file);
+            file = NULL;
+        }
+    }
+
+    // Number of games recorded for a board size
+    long long gameCount(int squaresPerSide) { return isValidBoardSize( squaresPerSide) ? gamesBySize[ squaresPerSide] : 0; }
+
+    // Number of best games kept for a board size, at most ScoreIndexTopGames
+    int topGameCount(int squaresPerSide) { return isValidBoardSize( squaresPerSide) ? topBySize[ squaresPerSide].size() : 0; }
+
+    // Return the game with the given rank (0 is the best) for a board size.
+    // rank must be less than topGameCount( squaresPerSide).
+    GameRecord& rankedGame(int squaresPerSide, int rank) { return topBySize[ squaresPerSide][ rank]; }
+
+    // Return the percentage of games for a board size with a lower score than score
+    double percentile(int squaresPerSide, int score) {
+        if( gameCount( squaresPerSide) == 0) {
+            return 100;
+        }
+        long long beaten = 0;
+        std::map<int, int>::iterator end = scoreCounts[ squaresPerSide].lower_bound( score);
+        for( std::map<int, int>::iterator it = scoreCounts[ squaresPerSide].begin(); it != end; it++) {
+            beaten += it->second;
+        }
+        return 100.0 * beaten / gamesBySize[ squaresPerSide];
+    }
+};//end ScoreStore class
+
 //--------------------------------------------------------------------
 // Display Instructions
 void displayInstructions()
@@ -250,6 +700,12 @@ void displayInstructions()
 			  << "two originals. This value gets added to the score.  On each move    \n"
 			  << "one new randomly chosen value of 2 or 4 is placed in a random open  \n"
 			  << "square.  User input of x exits the game.                            \n"
+			  << "  \n"
+			  << "Enter b to let the computer play.  Drag the slider in the window to  \n"
+			  << "change its speed and press Escape in the window to take over again.  \n"
+			  << "Enter h for a perfect-play hint towards a smaller target tile on a   \n"
+			  << "4x4 board.  The hint reads a table built by running the program with \n"
+			  << "the arguments:  solve <target>                                       \n"
 			  << "  \n";
 }//end displayInstructions()
 
@@ -278,12 +734,14 @@ void placeRandomPiece(int* board, int squaresPerSide)
 //--------------------------------------------------------------------
 // Prompt for and get board size, dynamically allocate space for the
 // board, initialize the board and set the max tile value that
-// corresponds to the board size.
+// corresponds to the board size.  The random number generator is
+// seeded for the new game and the seed is returned so it can be saved.
 void initializeBoards(
          int* &board,           // Playing board
          Square* &squaresArray, // Graphical board
          int &squaresPerSide,   // size of the board, entered by user
-         int &maxTileValue)
+         int &maxTileValue,
+         unsigned int &seed)    // seed used for this game's random pieces
 {
     //Allocate memory for board and squaresArray
     board = new int[squaresPerSide*squaresPerSide];
@@ -302,11 +760,16 @@ void initializeBoards(
     std::cout << "Game ends when you reach " << maxTileValue << "." << std::endl;
     
     // Set two random pieces to start game
+    // Mix the system's random source with the clock in nanoseconds, so games started
+    // within the same second, or on a system whose random source is fixed, still differ
+    std::random_device randomSource;
+    seed = randomSource() ^ (unsigned int) std::chrono::steady_clock::now().time_since_epoch().count();
+    srand( seed);
     placeRandomPiece( board, squaresPerSide);
     placeRandomPiece( board, squaresPerSide);
 }//end initializeBoards()
 
-void updateSquareBoard(Square* &squaresArray, int arraySize, int* board, sf::Font &font, sf::RenderWindow &window) {
+void updateSquareBoard(Square* &squaresArray, int arraySize, int* board, GlyphAtlas &font, sf::RenderWindow &window) {
    
     for( int i=0; i<arraySize; i++) {
         for (int j = 0; j < arraySize; j++) {
@@ -597,8 +1060,1032 @@ void undo(int* &board, int &move, int &score, int &squaresPerSide, LinkedList &l
     score = list.top()->score;
 } //end undo()
 
+//--------------------------------------------------------------------
+// Make the move for a direction key (a, s, d or w), updating the score
+void slideInDirection( int* board, int squaresPerSide, char direction, int &score)
+{
+    switch (direction) {
+        case 'a': slideLeft( board, squaresPerSide, score);  break;
+        case 's': slideDown( board, squaresPerSide, score);  break;
+        case 'd': slideRight( board, squaresPerSide, score); break;
+        case 'w': slideUp( board, squaresPerSide, score);    break;
+    }
+}//end slideInDirection()
+
+
+//--------------------------------------------------------------------
+// Exact solver for a 4x4 game that is stopped at a smaller target tile.
+// Each board is packed into 64 bits, 4 bits per square, holding the
+// power of two of the tile (0 for an empty square).  Square i is in
+// bits 4*i to 4*i+3, so each row of the board is 16 bits.
+typedef unsigned long long PackedBoard;
+
+// Each possible row of 4 squares after sliding it left, filled in by initializeRowMoves()
+unsigned short rowAfterLeft[ 65536];
+
+// Fill in rowAfterLeft using slideLeft(), so the solver follows the same rules as the game
+void initializeRowMoves()
+{
+    static bool initialized = false;
+    if( initialized) {
+        return;
+    }
+    for( int row=0; row<65536; row++) {
+        int board[ SolverSquaresPerSide*SolverSquaresPerSide] = { 0};
+        for( int col=0; col<SolverSquaresPerSide; col++) {
+            int power = (row >> (4*col)) & 0xF;
+            board[ col] = (power == 0) ? 0 : (1 << power);
+        }
+        int tempScore = 0;   // used as a placeHolder only
+        slideLeft( board, SolverSquaresPerSide, tempScore);
+        int result = 0;
+        for( int col=0; col<SolverSquaresPerSide; col++) {
+            int power = 0;
+            for( int value=board[ col]; value > 1; value = value / 2) {
+                power++;
+            }
+            result = result | ((power & 0xF) << (4*col));
+        }
+        rowAfterLeft[ row] = result;
+    }
+    initialized = true;
+}//end initializeRowMoves()
+
+// Pack a 4x4 board into 64 bits
+PackedBoard packBoard( int* board)
+{
+    PackedBoard key = 0;
+    for( int i=0; i<SolverSquaresPerSide*SolverSquaresPerSide; i++) {
+        int power = 0;
+        for( int value=board[ i]; value > 1; value = value / 2) {
+            power++;
+        }
+        key = key | ((PackedBoard)power << (4*i));
+    }
+    return key;
+}//end packBoard()
+
+// Swap rows and columns
+PackedBoard transposeBoard( PackedBoard x)
+{
+    PackedBoard a = (x & 0xF0F00F0FF0F00F0FULL) | ((x & 0x0000F0F00000F0F0ULL) << 12) | ((x >> 12) & 0x0000F0F00000F0F0ULL);
+    return (a & 0xFF00FF0000FF00FFULL) | ((a & 0x00FF00FF00000000ULL) >> 24) | ((a & 0x00000000FF00FF00ULL) << 24);
+}
+
+// Mirror left to right
+PackedBoard flipRows( PackedBoard x)
+{
+    return ((x & 0x000F000F000F000FULL) << 12) | ((x & 0x00F000F000F000F0ULL) << 4) |
+           ((x & 0x0F000F000F000F00ULL) >> 4)  | ((x & 0xF000F000F000F000ULL) >> 12);
+}
+
+// Mirror top to bottom
+PackedBoard flipColumns( PackedBoard x)
+{
+    return (x << 48) | ((x & 0xFFFF0000ULL) << 16) | ((x >> 16) & 0xFFFF0000ULL) | (x >> 48);
+}
+
+// A board that is rotated or flipped has the same chance of winning, so the
+// solver only keeps the smallest packed value of its 8 rotations and reflections
+PackedBoard canonicalBoard( PackedBoard x)
+{
+    PackedBoard t = transposeBoard( x);
+    PackedBoard variants[ 8] = { x, flipRows( x), flipColumns( x), flipRows( flipColumns( x)),
+                                 t, flipRows( t), flipColumns( t), flipRows( flipColumns( t)) };
+    PackedBoard smallest = x;
+    for( int i=1; i<8; i++) {
+        if( variants[ i] < smallest) {
+            smallest = variants[ i];
+        }
+    }
+    return smallest;
+}//end canonicalBoard()
+
+// Return true if the board holds a tile of at least 2 to the power given
+bool hasTile( PackedBoard x, int power)
+{
+    for( int i=0; i<SolverSquaresPerSide*SolverSquaresPerSide; i++) {
+        if( (int)((x >> (4*i)) & 0xF) >= power) {
+            return true;
+        }
+    }
+    return false;
+}//end hasTile()
+
+// Make the move for a direction key (a, s, d or w) on a packed board
+PackedBoard slidePacked( PackedBoard x, char direction)
+{
+    if( direction == 'w' || direction == 's') {
+        // Up and down are left and right on the transposed board
+        return transposeBoard( slidePacked( transposeBoard( x), (direction == 'w') ? 'a' : 'd'));
+    }
+    if( direction == 'd') {
+        return flipRows( slidePacked( flipRows( x), 'a'));
+    }
+    PackedBoard result = 0;
+    for( int row=0; row<SolverSquaresPerSide; row++) {
+        result = result | ((PackedBoard)rowAfterLeft[ (x >> (16*row)) & 0xFFFF] << (16*row));
+    }
+    return result;
+}//end slidePacked()
+
+
+//--------------------------------------------------------------------
+// A file mapped into memory with mmap(), so boards are read and written
+// in place and the operating system decides how much of it is in RAM.
+class MappedFile {
+    private:
+    void* data;
+    size_t size;
+
+    public:
+    MappedFile() {
+        data = NULL;
+        size = 0;
+    }
+    ~MappedFile() { close(); }
+
+    // Map an existing file for reading.  Returns false if it cannot be opened.
+    bool open( std::string fileName) {
+        close();
+        int descriptor = ::open( fileName.c_str(), O_RDONLY);
+        if( descriptor < 0) {
+            return false;
+        }
+        struct stat fileStatus;
+        fstat( descriptor, &fileStatus);
+        size = fileStatus.st_size;
+        if( size > 0) {
+            data = mmap( NULL, size, PROT_READ, MAP_SHARED, descriptor, 0);
+            if( data == MAP_FAILED) {
+                data = NULL;
+                size = 0;
+                ::close( descriptor);
+                return false;
+            }
+        }
+        ::close( descriptor);
+        return true;
+    }
+
+    // Create a file of the given size and map it for writing.  The disk space is
+    // reserved up front, so a full disk is reported here and not as a crash later
+    // when a page of the map is first written.  A file that could not be set up is removed.
+    bool create( std::string fileName, size_t bytes) {
+        close();
+        int descriptor = ::open( fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if( descriptor < 0) {
+            return false;
+        }
+        if( bytes > 0 && posix_fallocate( descriptor, 0, bytes) != 0) {
+            ::close( descriptor);
+            unlink( fileName.c_str());
+            return false;
+        }
+        size = bytes;
+        if( size > 0) {
+            data = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+            if( data == MAP_FAILED) {
+                data = NULL;
+                size = 0;
+                ::close( descriptor);
+                unlink( fileName.c_str());
+                return false;
+            }
+        }
+        ::close( descriptor);
+        return true;
+    }
+
+    // Write everything changed in the map out to the file.  Returns false if it could not be written.
+    bool sync() {
+        return data == NULL || msync( data, size, MS_SYNC) == 0;
+    }
+
+    void close() {
+        if( data != NULL) {
+            munmap( data, size);
+        }
+        data = NULL;
+        size = 0;
+    }
+
+    void* getData() { return data; }
+    size_t getSize() { return size; }
+};//end MappedFile class
+
+
+//--------------------------------------------------------------------
+// Split the range 0..count into one piece per worker thread and run work on each piece
+void runInParallel( size_t count, std::function<void(size_t, size_t)> work)
+{
+    int threadCount = std::thread::hardware_concurrency();
+    if( threadCount < 1) {
+        threadCount = 1;
+    }
+    std::vector<std::thread> workers;
+    for( int t=0; t<threadCount; t++) {
+        size_t first = count * t / threadCount;
+        size_t last = count * (t + 1) / threadCount;
+        workers.push_back( std::thread( work, first, last));
+    }
+    for( size_t t=0; t<workers.size(); t++) {
+        workers[ t].join();
+    }
+}//end runInParallel()
+
+
+//--------------------------------------------------------------------
+// Start of a solver table file.  The header is followed by the sorted
+// packed boards, then by the win probability of each board as a float.
+struct SolverTableHeader {
+    char magic[ 8];           // SolverTableMagic
+    int targetPower;          // power of two of the target tile
+    int reserved;
+    unsigned long long count; // number of boards in the table
+};
+const char SolverTableMagic[ 8] = { 'T', '1', '0', '2', '4', 'S', 'V', '1'};
+
+// Name of the table file for a target tile
+std::string solverTableName( int targetValue) { return "solver_" + std::to_string( targetValue) + ".table"; }
+
+
+//--------------------------------------------------------------------
+// Builds the solver table for a target tile, working on disk.  Every move
+// adds a 2 or 4 to the board, so boards are grouped into layers by the sum
+// of their tiles and a move only leads from one layer to the next two.
+//
+// First the layers are listed going forward from the two-tile starting
+// boards.  Worker threads each take part of a layer, make every move and
+// placeRandomPiece() outcome from it, and write what they find as sorted
+// run files.  The runs for the next layer are then merged into a single
+// sorted layer file.  Boards holding the target are wins and are not stored.
+//
+// Then the layers are solved going backward from the largest sum.  The
+// chance of winning from a board is the best over the 4 moves of the
+// average over every random piece placed afterwards, found by binary
+// search in the two layers after it, which are already solved.
+//
+// Finally all layers are merged into the table file that hints read.
+class RetrogradeSolver {
+    private:
+    int targetValue;
+    int targetPower;
+    std::string directory;    // where layer and run files are kept while building
+    std::mutex runMutex;      // guards runsByLayer, runCounter and failed
+    std::map<int, std::vector<std::string> > runsByLayer;   // run files waiting to be merged into each layer
+    int runCounter;
+    bool failed;              // set when any step of the build goes wrong, so build() stops and returns false
+
+    std::string layerName( int sum) { return directory + "/layer_" + std::to_string( sum) + ".boards"; }
+    std::string valuesName( int sum) { return directory + "/layer_" + std::to_string( sum) + ".values"; }
+
+    // Report a problem and mark the build as failed.  Safe to call from worker threads.
+    void fail( std::string message) {
+        std::lock_guard<std::mutex> lock( runMutex);
+        if( !failed) {
+            std::cout << message << std::endl;
+        }
+        failed = true;
+    }
+
+    // Sort boards, drop repeats, and write them as a run file for the layer with the given tile sum.
+    // Returns false if the file could not be written.
+    bool writeRun( int sum, std::vector<PackedBoard> &boards) {
+        std::sort( boards.begin(), boards.end());
+        boards.erase( std::unique( boards.begin(), boards.end()), boards.end());
+        if( boards.empty()) {
+            return true;
+        }
+        std::string runName;
+        {
+            std::lock_guard<std::mutex> lock( runMutex);
+            runName = directory + "/run_" + std::to_string( sum) + "_" + std::to_string( runCounter++) + ".run";
+            runsByLayer[ sum].push_back( runName);
+        }
+        FILE* output = fopen( runName.c_str(), "wb");
+        if( output == NULL) {
+            fail( "Unable to create " + runName);
+            return false;
+        }
+        bool written = fwrite( &boards[ 0], sizeof( PackedBoard), boards.size(), output) == boards.size();
+        // fclose() writes out what is still buffered, so it can fail too, such as when the disk is full
+        if( fclose( output) != 0 || !written) {
+            fail( "Unable to write " + runName);
+            return false;
+        }
+        boards.clear();
+        return true;
+    }
+
+    // Merge the sorted run files of a layer into one sorted layer file without repeats.
+    // Returns the number of boards in the layer, with failed set if the layer could not be written.
+    unsigned long long mergeRuns( int sum) {
+        std::vector<std::string> runNames = runsByLayer[ sum];
+        runsByLayer.erase( sum);
+
+        std::vector<MappedFile*> runs;
+        std::vector<size_t> positions;
+        // Smallest board at the front of each run, with the run it came from
+        std::priority_queue< std::pair<PackedBoard, int>, std::vector< std::pair<PackedBoard, int> >,
+                             std::greater< std::pair<PackedBoard, int> > > fronts;
+        bool ok = true;
+        for( size_t i=0; i<runNames.size(); i++) {
+            runs.push_back( new MappedFile);
+            positions.push_back( 0);
+            if( !runs[ i]->open( runNames[ i])) {
+                fail( "Unable to read " + runNames[ i]);
+                ok = false;
+            }
+            else if( runs[ i]->getSize() > 0) {
+                fronts.push( std::make_pair( ((PackedBoard*)runs[ i]->getData())[ 0], (int)i));
+            }
+        }
+
+        unsigned long long count = 0;
+        FILE* output = ok ? fopen( layerName( sum).c_str(), "wb") : NULL;
+        if( ok && output == NULL) {
+            fail( "Unable to create " + layerName( sum));
+            ok = false;
+        }
+        PackedBoard last = 0;
+        while( ok && !fronts.empty()) {
+            PackedBoard board = fronts.top().first;
+            int run = fronts.top().second;
+            fronts.pop();
+            if( count == 0 || board != last) {
+                if( fwrite( &board, sizeof( PackedBoard), 1, output) != 1) {
+                    ok = false;
+                    break;
+                }
+                last = board;
+                count++;
+            }
+            positions[ run]++;
+            if( positions[ run] < runs[ run]->getSize() / sizeof( PackedBoard)) {
+                fronts.push( std::make_pair( ((PackedBoard*)runs[ run]->getData())[ positions[ run]], run));
+            }
+        }
+        if( output != NULL && (fclose( output) != 0 || !ok)) {
+            fail( "Unable to write " + layerName( sum));
+        }
+
+        for( size_t i=0; i<runs.size(); i++) {
+            delete runs[ i];
+            unlink( runNames[ i].c_str());
+        }
+        return count;
+    }
+
+    // Add each board reachable in one move and one random piece from boards first..last-1
+    // of the layer with the given tile sum
+    void expandBoards( const PackedBoard* boards, size_t first, size_t last, int sum) {
+        std::vector<PackedBoard> plusTwo;    // boards for the layer with sum + 2
+        std::vector<PackedBoard> plusFour;   // boards for the layer with sum + 4
+        const char* directions = "aswd";
+        for( size_t i=first; i<last; i++) {
+            for( int d=0; directions[ d] != '\0'; d++) {
+                PackedBoard after = slidePacked( boards[ i], directions[ d]);
+                if( after == boards[ i]) {
+                    continue;   // Not a valid move
+                }
+                for( int square=0; square<SolverSquaresPerSide*SolverSquaresPerSide; square++) {
+                    if( ((after >> (4*square)) & 0xF) != 0) {
+                        continue;
+                    }
+                    PackedBoard withTwo = after | ((PackedBoard)1 << (4*square));
+                    PackedBoard withFour = after | ((PackedBoard)2 << (4*square));
+                    if( !hasTile( withTwo, targetPower)) {
+                        plusTwo.push_back( canonicalBoard( withTwo));
+                    }
+                    if( !hasTile( withFour, targetPower)) {
+                        plusFour.push_back( canonicalBoard( withFour));
+                    }
+                }
+            }
+            if( plusTwo.size() >= SolverRunBoards && !writeRun( sum + 2, plusTwo)) {
+                return;
+            }
+            if( plusFour.size() >= SolverRunBoards && !writeRun( sum + 4, plusFour)) {
+                return;
+            }
+        }
+        if( writeRun( sum + 2, plusTwo)) {
+            writeRun( sum + 4, plusFour);
+        }
+    }
+
+    // Win probability of a board with the player to move, given the two solved layers after it
+    float solveBoard( PackedBoard board, const PackedBoard* nextBoards[ 2], const float* nextValues[ 2],
+                      size_t nextCounts[ 2]) {
+        float best = 0;
+        const char* directions = "aswd";
+        for( int d=0; directions[ d] != '\0'; d++) {
+            PackedBoard after = slidePacked( board, directions[ d]);
+            if( after == board) {
+                continue;   // Not a valid move
+            }
+            double total = 0;
+            int openSquares = 0;
+            for( int square=0; square<SolverSquaresPerSide*SolverSquaresPerSide; square++) {
+                if( ((after >> (4*square)) & 0xF) != 0) {
+                    continue;
+                }
+                openSquares++;
+                for( int piece=1; piece<=2; piece++) {   // a 2, then a 4
+                    PackedBoard placed = after | ((PackedBoard)piece << (4*square));
+                    double chance = 1;
+                    if( !hasTile( placed, targetPower)) {
+                        PackedBoard key = canonicalBoard( placed);
+                        const PackedBoard* found = std::lower_bound( nextBoards[ piece - 1],
+                                                                     nextBoards[ piece - 1] + nextCounts[ piece - 1], key);
+                        // Every board that is not a win was listed going forward, so missing one
+                        // means the layer files are damaged or do not belong to this build
+                        if( found == nextBoards[ piece - 1] + nextCounts[ piece - 1] || *found != key) {
+                            fail( "A board is missing from the layer after it, the solver files are damaged");
+                            return 0;
+                        }
+                        chance = nextValues[ piece - 1][ found - nextBoards[ piece - 1]];
+                    }
+                    total += 0.5 * chance;
+                }
+            }
+            if( openSquares > 0 && total / openSquares > best) {
+                best = total / openSquares;
+            }
+        }
+        return best;
+    }
+
+    public:
+    RetrogradeSolver() {
+        targetValue = 0;
+        targetPower = 0;
+        runCounter = 0;
+        failed = false;
+    }
+
+    // Build the table file for a target tile.  Returns false if it could not be written.
+    bool build( int theTargetValue) {
+        targetValue = theTargetValue;
+        targetPower = 0;
+        for( int value=targetValue; value > 1; value = value / 2) {
+            targetPower++;
+        }
+        directory = "solver_" + std::to_string( targetValue) + ".work";
+        struct stat directoryStatus;
+        if( (mkdir( directory.c_str(), 0755) != 0 && errno != EEXIST) ||
+            stat( directory.c_str(), &directoryStatus) != 0 || !S_ISDIR( directoryStatus.st_mode)) {
+            std::cout << "Unable to make the directory " << directory << " for the solver's files" << std::endl;
+            return false;
+        }
+        initializeRowMoves();
+
+        // Starting boards: every way placeRandomPiece() can place the first two pieces
+        std::vector<PackedBoard> starts[ 3];   // tile sums 4, 6 and 8
+        for( int first=0; first<SolverSquaresPerSide*SolverSquaresPerSide; first++) {
+            for( int second=first+1; second<SolverSquaresPerSide*SolverSquaresPerSide; second++) {
+                for( int firstPiece=1; firstPiece<=2; firstPiece++) {
+                    for( int secondPiece=1; secondPiece<=2; secondPiece++) {
+                        PackedBoard board = ((PackedBoard)firstPiece << (4*first)) | ((PackedBoard)secondPiece << (4*second));
+                        if( !hasTile( board, targetPower)) {
+                            starts[ firstPiece + secondPiece - 2].push_back( canonicalBoard( board));
+                        }
+                    }
+                }
+            }
+        }
+        for( int i=0; i<3; i++) {
+            if( !writeRun( 4 + 2*i, starts[ i])) {
+                return false;
+            }
+        }
+
+        // Going forward, list the boards in each layer
+        std::vector<int> layerSums;
+        for( int sum=4; !runsByLayer.empty(); sum += 2) {
+            unsigned long long count = mergeRuns( sum);
+            if( failed) {
+                return false;
+            }
+            std::cout << "Tile sum " << sum << ": " << count << " boards" << std::endl;
+            layerSums.push_back( sum);
+            MappedFile layer;
+            if( !layer.open( layerName( sum))) {
+                std::cout << "Unable to read " << layerName( sum) << std::endl;
+                return false;
+            }
+            const PackedBoard* boards = (const PackedBoard*)layer.getData();
+            runInParallel( count, [&]( size_t first, size_t last) { expandBoards( boards, first, last, sum); });
+            if( failed) {
+                return false;
+            }
+        }
+
+        // Going backward, solve each layer from the two after it
+        unsigned long long total = 0;
+        for( int i=layerSums.size() - 1; i>=0; i--) {
+            int sum = layerSums[ i];
+            std::cout << "Solving tile sum " << sum << std::endl;
+            MappedFile layer, values, nextLayers[ 2], nextValueFiles[ 2];
+            if( !layer.open( layerName( sum))) {
+                std::cout << "Unable to read " << layerName( sum) << std::endl;
+                return false;
+            }
+            size_t count = layer.getSize() / sizeof( PackedBoard);
+            if( !values.create( valuesName( sum), count * sizeof( float))) {
+                std::cout << "Unable to write " << valuesName( sum) << std::endl;
+                return false;
+            }
+            const PackedBoard* nextBoards[ 2];
+            const float* nextValues[ 2];
+            size_t nextCounts[ 2];
+            for( int piece=1; piece<=2; piece++) {
+                // Layers past the last one do not exist, and are left empty
+                if( sum + 2*piece <= layerSums.back() &&
+                    (!nextLayers[ piece - 1].open( layerName( sum + 2*piece)) ||
+                     !nextValueFiles[ piece - 1].open( valuesName( sum + 2*piece)) ||
+                     nextValueFiles[ piece - 1].getSize() / sizeof( float) != nextLayers[ piece - 1].getSize() / sizeof( PackedBoard))) {
+                    std::cout << "Unable to read the solved layer with tile sum " << sum + 2*piece << std::endl;
+                    return false;
+                }
+                nextBoards[ piece - 1] = (const PackedBoard*)nextLayers[ piece - 1].getData();
+                nextValues[ piece - 1] = (const float*)nextValueFiles[ piece - 1].getData();
+                nextCounts[ piece - 1] = nextLayers[ piece - 1].getSize() / sizeof( PackedBoard);
+            }
+            const PackedBoard* boards = (const PackedBoard*)layer.getData();
+            float* layerValues = (float*)values.getData();
+            runInParallel( count, [&]( size_t first, size_t last) {
+                for( size_t b=first; b<last; b++) {
+                    layerValues[ b] = solveBoard( boards[ b], nextBoards, nextValues, nextCounts);
+                }
+            });
+            if( failed) {
+                return false;
+            }
+            if( !values.sync()) {
+                std::cout << "Unable to write " << valuesName( sum) << std::endl;
+                return false;
+            }
+            total += count;
+        }
+
+        // Merge the layers into one sorted table.  A board is in only one layer, so there are no repeats.
+        std::cout << "Writing " << solverTableName( targetValue) << " with " << total << " boards" << std::endl;
+        MappedFile table;
+        if( !table.create( solverTableName( targetValue),
+                           sizeof( SolverTableHeader) + total * (sizeof( PackedBoard) + sizeof( float)))) {
+            std::cout << "Unable to write " << solverTableName( targetValue) << std::endl;
+            return false;
+        }
+        SolverTableHeader* header = (SolverTableHeader*)table.getData();
+        memcpy( header->magic, SolverTableMagic, sizeof( SolverTableMagic));
+        header->targetPower = targetPower;
+        header->reserved = 0;
+        header->count = total;
+        PackedBoard* tableBoards = (PackedBoard*)(header + 1);
+        float* tableValues = (float*)(tableBoards + total);
+
+        std::vector<MappedFile*> layers, layerValues;
+        std::vector<size_t> positions;
+        std::priority_queue< std::pair<PackedBoard, int>, std::vector< std::pair<PackedBoard, int> >,
+                             std::greater< std::pair<PackedBoard, int> > > fronts;
+        for( size_t i=0; i<layerSums.size(); i++) {
+            layers.push_back( new MappedFile);
+            layerValues.push_back( new MappedFile);
+            positions.push_back( 0);
+            if( !layers[ i]->open( layerName( layerSums[ i])) || !layerValues[ i]->open( valuesName( layerSums[ i]))) {
+                std::cout << "Unable to read the solved layer with tile sum " << layerSums[ i] << std::endl;
+                failed = true;
+            }
+            else if( layers[ i]->getSize() > 0) {
+                fronts.push( std::make_pair( ((PackedBoard*)layers[ i]->getData())[ 0], (int)i));
+            }
+        }
+        unsigned long long written = 0;
+        while( !failed && !fronts.empty()) {
+            int i = fronts.top().second;
+            fronts.pop();
+            tableBoards[ written] = ((PackedBoard*)layers[ i]->getData())[ positions[ i]];
+            tableValues[ written] = ((float*)layerValues[ i]->getData())[ positions[ i]];
+            written++;
+            positions[ i]++;
+            if( positions[ i] < layers[ i]->getSize() / sizeof( PackedBoard)) {
+                fronts.push( std::make_pair( ((PackedBoard*)layers[ i]->getData())[ positions[ i]], (int)i));
+            }
+        }
+
+        if( !failed && (written != total || !table.sync())) {
+            std::cout << "Unable to write " << solverTableName( targetValue) << std::endl;
+            failed = true;
+        }
+        for( size_t i=0; i<layerSums.size(); i++) {
+            delete layers[ i];
+            delete layerValues[ i];
+        }
+        if( failed) {
+            // Do not leave a table behind that hints would trust
+            table.close();
+            unlink( solverTableName( targetValue).c_str());
+            return false;
+        }
+
+        // The layer files are no longer needed
+        for( size_t i=0; i<layerSums.size(); i++) {
+            unlink( layerName( layerSums[ i]).c_str());
+            unlink( valuesName( layerSums[ i]).c_str());
+        }
+        rmdir( directory.c_str());
+        return true;
+    }
+};//end RetrogradeSolver class
+
+
+//--------------------------------------------------------------------
+// Read-only view of a solver table file, used to give hints during a game
+class SolverTable {
+    private:
+    MappedFile file;
+    int targetValue;          // target tile of the loaded table, 0 if none is loaded
+    int targetPower;
+    const PackedBoard* boards;
+    const float* values;
+    unsigned long long count;
+
+    public:
+    SolverTable() {
+        targetValue = 0;
+        targetPower = 0;
+        boards = NULL;
+        values = NULL;
+        count = 0;
+    }
+
+    // Map the table for a target tile, if it has been built.  Returns false if there is none.
+    bool load( int theTargetValue) {
+        if( targetValue == theTargetValue) {
+            return true;
+        }
+        targetValue = 0;
+        if( !file.open( solverTableName( theTargetValue)) || file.getSize() < sizeof( SolverTableHeader)) {
+            return false;
+        }
+        int thePower = 0;
+        for( int value=theTargetValue; value > 1; value = value / 2) {
+            thePower++;
+        }
+        SolverTableHeader* header = (SolverTableHeader*)file.getData();
+        if( memcmp( header->magic, SolverTableMagic, sizeof( SolverTableMagic)) != 0 || header->targetPower != thePower ||
+            file.getSize() != sizeof( SolverTableHeader) + header->count * (sizeof( PackedBoard) + sizeof( float))) {
+            file.close();
+            return false;
+        }
+        initializeRowMoves();
+        targetValue = theTargetValue;
+        targetPower = header->targetPower;
+        count = header->count;
+        boards = (const PackedBoard*)(header + 1);
+        values = (const float*)(boards + count);
+        return true;
+    }
+
+    // Win probability of a board with the player to move, or -1 if it is not in the table
+    double lookup( PackedBoard board) {
+        if( hasTile( board, targetPower)) {
+            return 1;
+        }
+        PackedBoard key = canonicalBoard( board);
+        const PackedBoard* found = std::lower_bound( boards, boards + count, key);
+        if( found == boards + count || *found != key) {
+            return -1;
+        }
+        return values[ found - boards];
+    }
+
+    // Find the move with the best chance of reaching the target from board.
+    // Returns the direction key, ' ' if there is no move, or '?' if the board
+    // could not come up in a game and so is not in the table.
+    // probability is set to the chance of winning with the move.
+    char bestMove( int* board, double &probability) {
+        PackedBoard packed = packBoard( board);
+        char bestDirection = ' ';
+        probability = 0;
+        const char* directions = "aswd";
+        for( int d=0; directions[ d] != '\0'; d++) {
+            PackedBoard after = slidePacked( packed, directions[ d]);
+            if( after == packed) {
+                continue;   // Not a valid move
+            }
+            double total = 0;
+            int openSquares = 0;
+            for( int square=0; square<SolverSquaresPerSide*SolverSquaresPerSide; square++) {
+                if( ((after >> (4*square)) & 0xF) != 0) {
+                    continue;
+                }
+                openSquares++;
+                for( int piece=1; piece<=2; piece++) {   // a 2, then a 4
+                    double chance = lookup( after | ((PackedBoard)piece << (4*square)));
+                    if( chance < 0) {
+                        return '?';
+                    }
+                    total += 0.5 * chance;
+                }
+            }
+            if( bestDirection == ' ' || total / openSquares > probability) {
+                bestDirection = directions[ d];
+                probability = total / openSquares;
+            }
+        }
+        return bestDirection;
+    }
+};//end SolverTable class
+
+//---------------------------------------------------------------------------------
+// Prompt for a target tile and display the move with the best chance of reaching it,
+// looked up in the solver table for that target
+void displayHint(int* board, int squaresPerSide, SolverTable &table) {
+    if (squaresPerSide != SolverSquaresPerSide) {
+        std::cout << "        *** Hints are only available on a 4x4 board. ***\n";
+        return;
+    }
+    int targetValue;
+    std::cout << "Enter the target tile for the hint: ";
+    std::cin >> targetValue;
+    if (targetValue < 4 || targetValue > MaxTileStartValue || (targetValue & (targetValue - 1)) != 0) {
+        std::cout << "        *** Target must be a power of 2 between 4 and " << MaxTileStartValue << ". ***\n";
+        return;
+    }
+    if (!table.load(targetValue)) {
+        std::cout << "        *** No solver table for " << targetValue << ". Build it first by running this\n"
+                  << "            program with the arguments:  solve " << targetValue << " ***\n";
+        return;
+    }
+    for (int i=0; i<squaresPerSide*squaresPerSide; i++) {
+        if (board[ i] >= targetValue) {
+            std::cout << "        * You already have " << targetValue << " on the board *\n";
+            return;
+        }
+    }
+
+    double probability;
+    char direction = table.bestMove(board, probability);
+    if (direction == '?') {
+        std::cout << "        *** This board cannot come up in a normal game, so it is not in the table. ***\n";
+    }
+    else if (direction == ' ') {
+        std::cout << "        * No moves are left *\n";
+    }
+    else {
+        std::cout << "        * Best move: " << direction << ", reaching " << targetValue
+                  << " with probability " << std::setprecision( 4) << probability << " *\n";
+    }
+} //end displayHint()
+
+//--------------------------------------------------------------------
+// Pick the computer's move: keep the big tiles in the bottom-left corner by
+// trying down, then left, then right, then up.  Returns ' ' if no move changes the board.
+char chooseAutoplayMove( int* board, int squaresPerSide)
+{
+    const char* directions = "sadw";
+    int boardCopy[ squaresPerSide * squaresPerSide];
+    for( int i=0; directions[ i] != '\0'; i++) {
+        copyBoard( boardCopy, board, squaresPerSide);
+        int tempScore = 0;   // used as a placeHolder only
+        slideInDirection( boardCopy, squaresPerSide, directions[ i], tempScore);
+        if( boardChangedThisTurn( board, boardCopy, squaresPerSide)) {
+            return directions[ i];
+        }
+    }
+    return ' ';
+}//end chooseAutoplayMove()
+
+//--------------------------------------------------------------------
+// Draw the autoplay speed slider and the moves per second label
+void drawAutoplayControls( sf::RenderWindow &window, GlyphAtlas &font, int speedLevel, int movesPerSecond)
+{
+    sf::RectangleShape track( sf::Vector2f( SliderWidth, 4));
+    track.setPosition( SliderXPosition, SliderYPosition);
+    track.setFillColor( sf::Color::White);
+    window.draw( track);
+    
+    sf::RectangleShape knob( sf::Vector2f( SliderKnobWidth, 24));
+    knob.setPosition( SliderXPosition + speedLevel * SliderWidth / (AutoplaySpeedCount - 1) - SliderKnobWidth / 2, SliderYPosition - 10);
+    knob.setFillColor( sf::Color::Yellow);
+    window.draw( knob);
+    
+    char aString[ 80];
+    if( AutoplaySpeeds[ speedLevel] == 0) {
+        sprintf( aString, "Autoplay: %d moves/sec   Speed: unlimited", movesPerSecond);
+    }
+    else {
+        sprintf( aString, "Autoplay: %d moves/sec   Speed: %d/sec", movesPerSecond, AutoplaySpeeds[ speedLevel]);
+    }
+    font.drawText( window, aString, SliderXPosition, SliderYPosition - 40, font.scaleFor( 20), sf::Color(255,255,255));
+}//end drawAutoplayControls()
+
+//--------------------------------------------------------------------
+// Let the computer play until the game ends, the window closes or Escape is
+// pressed.  Moves are made as fast as the slider allows, while the window is
+// only redrawn every AutoplayFrameMilliseconds with the latest board, so
+// boards in between are skipped.  Each move is still stored in the linked
+// list so it can be undone later.
+void autoplay( int* board, Square* &squaresArray, int squaresPerSide, int &score, int &moveNumber,
+               int maxTileValue, LinkedList &list, sf::RenderWindow &window, GlyphAtlas &font)
+{
+    static int speedLevel = AutoplaySpeedCount - 1;   // Remember the slider between runs, start unlimited
+    bool draggingSlider = false;
+    bool playing = true;
+    int movesThisSecond = 0;
+    int movesPerSecond = 0;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point nextMove = now;
+    std::chrono::steady_clock::time_point nextFrame = now;
+    std::chrono::steady_clock::time_point nextSecond = now + std::chrono::seconds( 1);
+    
+    while( playing && window.isOpen()) {
+        // Handle window events: closing, Escape, and the speed slider
+        sf::Event event;
+        while( window.pollEvent( event)) {
+            int mouseX = -1;
+            if( event.type == sf::Event::Closed) {
+                window.close();
+            }
+            else if( event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
+                playing = false;
+            }
+            else if( event.type == sf::Event::MouseButtonPressed &&
+                     event.mouseButton.x >= SliderXPosition - SliderKnobWidth &&
+                     event.mouseButton.x <= SliderXPosition + SliderWidth + SliderKnobWidth &&
+                     event.mouseButton.y >= SliderYPosition - 15 && event.mouseButton.y <= SliderYPosition + 20) {
+                draggingSlider = true;
+                mouseX = event.mouseButton.x;
+            }
+            else if( event.type == sf::Event::MouseButtonReleased) {
+                draggingSlider = false;
+            }
+            else if( event.type == sf::Event::MouseMoved && draggingSlider) {
+                mouseX = event.mouseMove.x;
+            }
+            if( mouseX >= 0) {
+                // Snap to the nearest speed on the slider
+                speedLevel = ((mouseX - SliderXPosition) * (AutoplaySpeedCount - 1) + SliderWidth / 2) / SliderWidth;
+                if( speedLevel < 0) {
+                    speedLevel = 0;
+                }
+                if( speedLevel > AutoplaySpeedCount - 1) {
+                    speedLevel = AutoplaySpeedCount - 1;
+                }
+                nextMove = std::chrono::steady_clock::now();
+            }
+        }
+        
+        // Make a move if one is due
+        now = std::chrono::steady_clock::now();
+        if( playing && now >= nextMove) {
+            char direction = chooseAutoplayMove( board, squaresPerSide);
+            if( direction == ' ') {
+                playing = false;   // No moves left, gameIsOver() in main() reports it
+            }
+            else {
+                slideInDirection( board, squaresPerSide, direction, score);
+                placeRandomPiece( board, squaresPerSide);
+                moveNumber++;
+                list.push( board, squaresPerSide, moveNumber, score);
+                movesThisSecond++;
+                for( int i=0; i<squaresPerSide*squaresPerSide; i++) {
+                    if( board[ i] == maxTileValue) {
+                        playing = false;   // Reached the end tile, gameIsOver() in main() reports it
+                    }
+                }
+            }
+            if( AutoplaySpeeds[ speedLevel] != 0) {
+                nextMove = nextMove + std::chrono::microseconds( 1000000 / AutoplaySpeeds[ speedLevel]);
+                if( nextMove < now) {
+                    nextMove = now;   // Do not race to catch up after a pause
+                }
+            }
+        }
+        
+        if( now >= nextSecond) {
+            movesPerSecond = movesThisSecond;
+            movesThisSecond = 0;
+            nextSecond = now + std::chrono::seconds( 1);
+        }
+        
+        // Redraw the latest board when a frame is due, or one last time when done
+        if( now >= nextFrame || !playing) {
+            window.clear();
+            updateSquareBoard( squaresArray, squaresPerSide, board, font, window);
+            drawAutoplayControls( window, font, speedLevel, movesPerSecond);
+            window.display();
+            nextFrame = now + std::chrono::milliseconds( AutoplayFrameMilliseconds);
+        }
+        
+        // When moves are limited, rest until the next move or frame is due
+        if( playing && AutoplaySpeeds[ speedLevel] != 0) {
+            std::chrono::steady_clock::time_point wakeUp = (nextMove < nextFrame) ? nextMove : nextFrame;
+            std::this_thread::sleep_until( wakeUp);
+        }
+    }
+}//end autoplay()
+
+//--------------------------------------------------------------------
+// Draw the top scores for each board size that has any games saved
+void drawLeaderboards( sf::RenderWindow &window, GlyphAtlas &font, ScoreStore &store)
+{
+    int yPosition = LeaderboardYPosition;
+    for( int size=4; size<=MaxBoardSize; size++) {
+        if( store.gameCount( size) == 0) {
+            continue;
+        }
+        char aString[ 120];
+        int length = sprintf( aString, "%dx%d best:", size, size);
+        for( int rank=0; rank<LeaderboardSize && rank<store.topGameCount( size); rank++) {
+            length += sprintf( aString + length, " %d", store.rankedGame( size, rank).score);
+        }
+        sprintf( aString + length, "   (%lld games)", store.gameCount( size));
+        
+        // Shrink long lines until they fit across the window
+        int scale = font.scaleFor( 16);
+        while( scale > 1 && font.textWidth( aString, scale) > WindowXSize - 2 * LeaderboardXPosition) {
+            scale--;
+        }
+        font.drawText( window, aString, LeaderboardXPosition, yPosition, scale, sf::Color(255,255,255));
+        yPosition += GlyphHeight * scale + 2;   // Keeps all 9 board sizes above the autoplay controls
+    }
+}//end drawLeaderboards()
+
+//--------------------------------------------------------------------
+// Save a finished game to the score store and display how it ranks
+void recordGame( ScoreStore &store, int* board, int squaresPerSide, int score, int moveNumber,
+                 unsigned int seed, std::chrono::steady_clock::time_point gameStart)
+{
+    GameRecord record;
+    record.squaresPerSide = squaresPerSide;
+    record.score = score;
+    record.maxTile = 0;
+    for( int i=0; i<squaresPerSide*squaresPerSide; i++) {
+        if( board[ i] > record.maxTile) {
+            record.maxTile = board[ i];
+        }
+    }
+    record.moves = moveNumber;
+    record.milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::steady_clock::now() - gameStart).count();
+    record.seed = seed;
+    
+    // Rank against the earlier games before this one is added
+    double percentile = store.percentile( squaresPerSide, score);
+    long long earlierGames = store.gameCount( squaresPerSide);
+    store.add( record);
+    
+    std::cout << "Final score: " << score << ", max tile " << record.maxTile << ".\n";
+    if( earlierGames > 0) {
+        std::cout << "That beats " << std::fixed << std::setprecision( 1) << percentile << std::defaultfloat
+                  << "% of the " << earlierGames << " games saved for " << squaresPerSide << "x" << squaresPerSide << ".\n";
+    }
+}//end recordGame()
+
+//--------------------------------------------------------------------
+// Return the milliseconds since the process was started, including the time
+// the loader spent loading SFML and OpenGL before main() runs.  The start
+// time is field 22 of /proc/self/stat, in clock ticks (usually 10 ms) since
+// boot, and is compared against CLOCK_BOOTTIME.  If /proc cannot be read,
+// fromProcessStart is set to false and the time since ProcessStart, which
+// leaves out the loader, is returned instead.
+long long millisecondsSinceProcessStart( bool &fromProcessStart)
+{
+    fromProcessStart = false;
+    long long sinceGlobals = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::steady_clock::now() - ProcessStart).count();
+    char line[ 1024];
+    FILE* input = fopen( "/proc/self/stat", "r");
+    if( input == NULL) {
+        return sinceGlobals;
+    }
+    bool readLine = fgets( line, sizeof( line), input) != NULL;
+    fclose( input);
+    // The program name in field 2 is in parentheses and may hold spaces, so count from after it
+    char* field = readLine ? strrchr( line, ')') : NULL;
+    if( field == NULL) {
+        return sinceGlobals;
+    }
+    field = strtok( field + 1, " ");   // field 3
+    for( int i=3; i<22 && field != NULL; i++) {
+        field = strtok( NULL, " ");
+    }
+    struct timespec now;
+    if( field == NULL || clock_gettime( CLOCK_BOOTTIME, &now) != 0) {
+        return sinceGlobals;
+    }
+    long long startMilliseconds = strtoull( field, NULL, 10) * 1000 / sysconf( _SC_CLK_TCK);
+    long long nowMilliseconds = (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+    fromProcessStart = true;
+    return nowMilliseconds - startMilliseconds;
+}//end millisecondsSinceProcessStart()
+
 //---------------------------------------------------------------------------------------
-int main()
+int main( int argc, char* argv[])
 {	
 	int moveNumber = 1;               // User move counter
 	int score = 0;                    // Cummulative score, which is sum of combined tiles
@@ -606,42 +2093,70 @@ int main()
 	int* board;                       // pointer to the board
     Square* squaresArray;             // pointer an array of Square objects
     LinkedList list;                  // List to store each move
+    SolverTable solverTable;          // Exact solver results used for hints
     int maxTileValue = 1024;          // 1024 for 4x4 board, 2048 for 5x5, 4096 for 6x6, etc.
     char userInput = ' ';             // Stores user input
+    unsigned int seed;                // Seed for this game's random pieces
+    ScoreStore store;                 // Every finished game, with top scores for each board size
+    sf::RenderWindow window;          // The graphics window, created once setup has started
+    GlyphAtlas font;                  // Built-in font, used in displaying text
+    bool firstFrame = true;           // Used to report the startup time once
     
-	// Create the graphics window
-	sf::RenderWindow window(sf::VideoMode(WindowXSize, WindowYSize), "Program 6: 1024 with Undo", sf::Style::Default);
-	std::cout << std::endl;
-    
-    // Create and initialize the font, to be used in displaying text.
-	sf::Font font;  
-	initializeFont( font);
-    
-	// Create the messages label at the bottom of the graphics screen, for displaying debugging information
-	sf::Text messagesLabel( "Welcome to 1024", font, 20);
-    
-	// Make a text object from the font
-	messagesLabel.setColor( sf::Color(255,255,255));
+    // Run with the arguments  solve <target>  to build the solver table used for hints, then exit
+    if( argc == 3 && strcmp( argv[ 1], "solve") == 0) {
+        int targetValue = atoi( argv[ 2]);
+        if( targetValue < 4 || targetValue > MaxTileStartValue || (targetValue & (targetValue - 1)) != 0) {
+            std::cout << "Target must be a power of 2 between 4 and " << MaxTileStartValue << "." << std::endl;
+            return -1;
+        }
+        RetrogradeSolver solver;
+        return solver.build( targetValue) ? 0 : -1;
+    }
     
-	// Place text at the bottom of the window. Position offsets are x,y from 0,0 in upper-left of window
-	messagesLabel.setPosition( 0, WindowYSize - messagesLabel.getCharacterSize() - 5); 
-	
 	displayInstructions();
     
+    // Read back the games played before, for the leaderboards.  This grows with the number of
+    // games saved, so it runs on a second thread while this one sets up the board and window,
+    // and the first frame does not wait for it.  The leaderboards are added once it is done.
+    std::thread storeThread( [&]() { store.open( ScoreFileName, ScoreIndexFileName); });
+    
     // Get the board size, create and initialize the board, and set the max tile value
-    initializeBoards( board, squaresArray, squaresPerSide, maxTileValue);
+    initializeBoards( board, squaresArray, squaresPerSide, maxTileValue, seed);
+	std::cout << std::endl;
+    std::chrono::steady_clock::time_point gameStart = std::chrono::steady_clock::now();
     
     //Store a copy of the board in the linked list
     list.push(board, squaresPerSide, moveNumber, score);
+    
+	// Create the graphics window, then the font texture which needs the window's context
+	window.create(sf::VideoMode(WindowXSize, WindowYSize), "Program 6: 1024 with Undo", sf::Style::Default);
+	font.load();
 
 	// Run the program as long as the window is open.  This is known as the "Event loop".
 	while (window.isOpen())
 	{
-        //update the graphical board
+        //update the graphical board, and the leaderboards once the scores have been read
         updateSquareBoard(squaresArray, squaresPerSide, board, font, window);
+        if( !storeThread.joinable()) {
+            drawLeaderboards(window, font, store);
+        }
     
 		// Display both the graphical and text boards.
 		window.display();
+        if( firstFrame) {
+            bool fromProcessStart;
+            long long milliseconds = millisecondsSinceProcessStart( fromProcessStart);
+            std::cout << "Started in " << milliseconds << " ms"
+                      << (fromProcessStart ? "" : " (not counting the time to load libraries)") << "." << std::endl;
+            firstFrame = false;
+        }
+        if( storeThread.joinable()) {
+            // The first frame is up, so now wait for the scores and redraw with the leaderboards
+            storeThread.join();
+            updateSquareBoard(squaresArray, squaresPerSide, board, font, window);
+            drawLeaderboards(window, font, store);
+            window.display();
+        }
         displayAsciiBoard( board, squaresPerSide, score, list);
         
         // Prompt for and handle user input
@@ -650,6 +2165,7 @@ int main()
         switch (userInput) {
             case 'x':
                     std::cout << "Thanks for playing. Exiting program... \n\n";
+                    store.close();   // exit() skips the destructor, so save the scores here
                     exit( 0);
                     break;
             case 'r':
@@ -657,8 +2173,15 @@ int main()
                               << "Resetting board \n"
                               << "\n";
                     // Prompt for board size
-                    std::cout << "Enter the size board you want, between 4 and 12: ";
+                    std::cout << "Enter the size board you want, between 4 and " << MaxBoardSize << ": ";
                     std::cin >> squaresPerSide;
+                    while( std::cin && !isValidBoardSize( squaresPerSide)) {
+                        std::cout << "Board size must be between 4 and " << MaxBoardSize << ", please retry: ";
+                        std::cin >> squaresPerSide;
+                    }
+                    if( !isValidBoardSize( squaresPerSide)) {
+                        squaresPerSide = 4;   // Input ended, so fall back to the default size
+                    }
                 
                     //delete board, squaresArray and clear the linked list
                     delete [] board;
@@ -667,9 +2190,10 @@ int main()
                 
                     //initialize board and squaresArray. Reset moveNumber and Score.
                     //Store a copy of the board in the linked list
-                    initializeBoards( board, squaresArray, squaresPerSide, maxTileValue);
+                    initializeBoards( board, squaresArray, squaresPerSide, maxTileValue, seed);
                     score = 0;
                     moveNumber = 1;
+                    gameStart = std::chrono::steady_clock::now();
                     list.push(board, squaresPerSide, moveNumber, score);
                     continue;  // go back up to main loop and restart game
                     break;
@@ -700,6 +2224,15 @@ int main()
                     undo(board, moveNumber, score, squaresPerSide, list);
                     continue;
                     break;
+            case 'b':
+                    // Moves are stored in the linked list as they are made, so the
+                    // check for a changed board below does not add another
+                    autoplay( board, squaresArray, squaresPerSide, score, moveNumber, maxTileValue, list, window, font);
+                    break;
+            case 'h':
+                    displayHint(board, squaresPerSide, solverTable);
+                    continue;  // A hint does not make a move
+                    break;
             default:
                     std::cout << "Invalid input, please retry.";
                     continue;
@@ -720,13 +2253,15 @@ int main()
         
         char aString[25];
         sprintf(aString, "%d. Your move:", moveNumber);
-        messagesLabel.setString(aString);
-        window.draw(messagesLabel);
+        // Place text at the bottom of the window. Position offsets are x,y from 0,0 in upper-left of window
+        font.drawText(window, aString, 0, WindowYSize - GlyphHeight * font.scaleFor( 20) - 5, font.scaleFor( 20), sf::Color(255,255,255));
         
 		// See if we're done
 		if( gameIsOver( board, squaresPerSide, maxTileValue)) {
             // Display the final board
             displayAsciiBoard( board, squaresPerSide, score, list);
+            // Save the game, then show how it ranks against the ones before it
+            recordGame( store, board, squaresPerSide, score, moveNumber, seed, gameStart);
             // Clear the linked list
             list.clear();
             break;
@@ -739,5 +2274,11 @@ int main()
 
 	}//end while( window.isOpen())
 
+	// The loop joins the score store's thread after the first frame, but if the window
+	// never opened it was not run, and a thread must be joined before it is destroyed
+	if( storeThread.joinable()) {
+		storeThread.join();
+	}
+
 	return 0;
 }//end main()